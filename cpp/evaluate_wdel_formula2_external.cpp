@@ -6,29 +6,71 @@
 #include <iomanip>
 #include <algorithm>
 #include <sstream>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
 
-// WDEL Formula 2: Aminpour et al. (2023) dimensionless approach
-double wdel_aminpour2023(double d, double Dn, double U, double h, double P_kPa, double RH, double SR) {
+// Local worker processes (--jobs) need POSIX process control
+#if defined(__unix__) || defined(__APPLE__)
+#define WDEL_HAVE_PROCESSES 1
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+// Physical constants shared by the dimensionless groups
+const double GRAVITY = 9.81;        // acceleration due to gravity (m/s^2)
+const double WATER_DENSITY = 1000;  // water density (kg/m^3)
+
+// Dimensionless groups from Aminpour et al. (2023)
+struct DimensionlessGroups {
+    double pi1;         // diameter ratio
+    double pi2;         // relative humidity
+    double pi3;         // Froude number
+    double pi4;         // solar radiation parameter
+    double pi5;         // pressure parameter
+};
+
+// Compute the dimensionless groups of WDEL Formula 2
+DimensionlessGroups aminpour2023_groups(double d, double Dn, double U, double h, double P_kPa, double RH, double SR) {
     // Constants
-    const double g = 9.81;   // acceleration due to gravity (m/s^2)
-    const double rho = 1000; // water density (kg/m^3)
+    const double g = GRAVITY;
+    const double rho = WATER_DENSITY;
     
     // Convert pressure from kPa to Pa
     double P_Pa = P_kPa * 1000;
     
     // Dimensionless parameters from Aminpour et al. (2023)
-    double pi1 = d / Dn;                                    // diameter ratio
-    double pi2 = RH;                                        // relative humidity
-    double pi3 = U / sqrt(g * h);                           // Froude number
-    double pi4 = SR * sqrt(rho / pow(rho * g * Dn, 3));     // solar radiation parameter
-    double pi5 = P_Pa / (rho * g * Dn);                     // pressure parameter
-    
+    DimensionlessGroups groups;
+    groups.pi1 = d / Dn;                                    // diameter ratio
+    groups.pi2 = RH;                                        // relative humidity
+    groups.pi3 = U / sqrt(g * h);                           // Froude number
+    groups.pi4 = SR * sqrt(rho / pow(rho * g * Dn, 3));     // solar radiation parameter
+    groups.pi5 = P_Pa / (rho * g * Dn);                     // pressure parameter
+    return groups;
+}
+
+// WDEL Formula 2 evaluated on precomputed dimensionless groups
+double wdel_aminpour2023_groups(double pi1, double pi2, double pi3, double pi4, double pi5) {
     // Placeholder functional relationship (using same coefficients as MATLAB version)
     double loss = 0.1 * pi1 + 0.05 * pi2 + 0.2 * pi3 + 0.15 * pi4 + 0.3 * pi5;
     
     return loss; // Return as fraction (0-1)
 }
 
+// WDEL Formula 2: Aminpour et al. (2023) dimensionless approach
+double wdel_aminpour2023(double d, double Dn, double U, double h, double P_kPa, double RH, double SR) {
+    DimensionlessGroups groups = aminpour2023_groups(d, Dn, U, h, P_kPa, RH, SR);
+    return wdel_aminpour2023_groups(groups.pi1, groups.pi2, groups.pi3, groups.pi4, groups.pi5);
+}
+
 // Test data structure
 struct TestData {
     std::string test_id;
@@ -64,213 +106,1424 @@ std::vector<std::string> split(const std::string& str, char delimiter) {
     return tokens;
 }
 
-// Function to load test data from file
-std::vector<TestData> loadTestData(const std::string& filename) {
-    std::vector<TestData> data;
-    std::ifstream file(filename);
+// Function to parse one CSV data line; returns false for comments, empty and short lines
+bool parseTestLine(const std::string& line, TestData& test) {
+    // Skip comment lines and empty lines
+    if (line.empty() || line[0] == '#') {
+        return false;
+    }
     
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open data file: " << filename << std::endl;
-        return data;
+    // Parse CSV line
+    std::vector<std::string> tokens = split(line, ',');
+    if (tokens.size() < 11) {
+        return false;
     }
+    test.test_id = tokens[0];
+    test.D_mm = std::stod(tokens[1]);
+    test.d_mm = std::stod(tokens[2]);
+    test.p_kPa = std::stod(tokens[3]);
+    test.V_ms = std::stod(tokens[4]);
+    test.Vp_ms = std::stod(tokens[5]);
+    test.T_C = std::stod(tokens[6]);
+    test.HR_pct = std::stod(tokens[7]);
+    test.ID_mmh = std::stod(tokens[8]);
+    test.WDEL_pct = std::stod(tokens[9]);
+    test.CUC_pct = std::stod(tokens[10]);
+    return true;
+}
+
+// Derived inputs computed once per test case
+struct DerivedFeatures {
+    double pi1;         // Diameter ratio d/Dn
+    double pi2;         // Relative humidity (fraction)
+    double pi3;         // Froude number U/sqrt(g*h)
+    double pi4;         // Solar radiation parameter
+    double pi5;         // Pressure parameter P/(rho*g*Dn)
+    double SR_Wm2;      // Solar radiation estimated from temperature (W/m^2)
+    double VPD_kPa;     // Vapour pressure deficit (kPa)
+};
+
+// Column-oriented feature table aligned row-by-row with a batch of TestData
+struct FeatureColumns {
+    std::vector<double> pi1;
+    std::vector<double> pi2;
+    std::vector<double> pi3;
+    std::vector<double> pi4;
+    std::vector<double> pi5;
+    std::vector<double> SR_Wm2;
+    std::vector<double> VPD_kPa;
     
-    std::string line;
-    while (std::getline(file, line)) {
-        // Skip comment lines and empty lines
-        if (line.empty() || line[0] == '#') {
-            continue;
+    size_t size() const { return pi1.size(); }
+    
+    void resize(size_t n) {
+        pi1.resize(n);
+        pi2.resize(n);
+        pi3.resize(n);
+        pi4.resize(n);
+        pi5.resize(n);
+        SR_Wm2.resize(n);
+        VPD_kPa.resize(n);
+    }
+    
+    void set(size_t i, const DerivedFeatures& f) {
+        pi1[i] = f.pi1;
+        pi2[i] = f.pi2;
+        pi3[i] = f.pi3;
+        pi4[i] = f.pi4;
+        pi5[i] = f.pi5;
+        SR_Wm2[i] = f.SR_Wm2;
+        VPD_kPa[i] = f.VPD_kPa;
+    }
+    
+    DerivedFeatures get(size_t i) const {
+        DerivedFeatures f = { pi1[i], pi2[i], pi3[i], pi4[i], pi5[i], SR_Wm2[i], VPD_kPa[i] };
+        return f;
+    }
+};
+
+// Function to hash one data line (64-bit FNV-1a); validates cached rows against their source
+uint64_t hashLine(const std::string& line) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : line) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Version of the derivation below; bump it whenever deriveFeatures changes so old caches are rejected
+const uint32_t DERIVATION_VERSION = 1;
+
+// Function to derive dimensionless groups and auxiliary inputs from raw test data
+DerivedFeatures deriveFeatures(const TestData& test) {
+    // Convert units for formula input
+    double Dn = test.D_mm / 1000.0;        // Main nozzle diameter (m)
+    double d = test.d_mm / 1000.0;         // Secondary nozzle diameter (m)
+    double U = test.V_ms;                  // Wind speed (m/s)
+    double h = 1.0;                        // Assume sprinkler height of 1.0 m
+    double RH = test.HR_pct / 100.0;       // Relative humidity (fraction)
+    
+    // Estimate solar radiation based on temperature
+    double SR = 200 + (test.T_C - 5) * 20;
+    SR = std::max(200.0, std::min(800.0, SR));
+    
+    // Vapour pressure deficit from saturation pressure (Tetens equation)
+    double es_kPa = 0.6108 * std::exp(17.27 * test.T_C / (test.T_C + 237.3));
+    
+    DimensionlessGroups groups = aminpour2023_groups(d, Dn, U, h, test.p_kPa, RH, SR);
+    DerivedFeatures f = { groups.pi1, groups.pi2, groups.pi3, groups.pi4, groups.pi5,
+                          SR, es_kPa * (1.0 - RH) };
+    return f;
+}
+
+// Feature cache: a binary file next to the data file holding one fixed-size row per
+// parsed data line, in file order. Rows carry the parsed inputs as well as the derived
+// features, so a cache hit skips CSV parsing and derivation; each row is only used if
+// the hash of its source line still matches.
+const char FEATURE_CACHE_MAGIC[8] = { 'W', 'D', 'E', 'L', 'F', 'E', 'A', 'T' };
+const uint32_t FEATURE_CACHE_FORMAT = 2;
+
+struct FeatureCacheHeader {
+    char magic[8];
+    uint32_t format_version;        // FEATURE_CACHE_FORMAT
+    uint32_t derivation_version;    // DERIVATION_VERSION the rows were derived with
+    uint32_t row_size;              // sizeof(FeatureCacheRow), rejects foreign layouts
+    uint32_t reserved;
+};
+
+struct FeatureCacheRow {
+    uint64_t offset;                // Byte offset of the source line in the data file
+    uint64_t line_hash;             // hashLine() of the source line
+    double inputs[10];              // D, d, p, V, Vp, T, HR, ID, WDEL, CUC as parsed
+    DerivedFeatures features;
+};
+
+// Sequential reader over feature cache rows, refilled in bulk
+struct FeatureCacheReader {
+    std::ifstream file;
+    std::vector<FeatureCacheRow> buffer;
+    size_t next = 0;                // Next unread row in buffer
+    size_t filled = 0;              // Rows currently held in buffer
+    bool stale = false;             // Set once a cached row had no matching data line
+};
+
+// Function to copy parsed inputs into a cache row
+void storeCachedInputs(FeatureCacheRow& row, const TestData& test) {
+    const double inputs[10] = { test.D_mm, test.d_mm, test.p_kPa, test.V_ms, test.Vp_ms,
+                                test.T_C, test.HR_pct, test.ID_mmh, test.WDEL_pct, test.CUC_pct };
+    std::copy(inputs, inputs + 10, row.inputs);
+}
+
+// Function to restore parsed inputs (all fields but test_id) from a cache row
+void loadCachedInputs(const FeatureCacheRow& row, TestData& test) {
+    test.D_mm = row.inputs[0];
+    test.d_mm = row.inputs[1];
+    test.p_kPa = row.inputs[2];
+    test.V_ms = row.inputs[3];
+    test.Vp_ms = row.inputs[4];
+    test.T_C = row.inputs[5];
+    test.HR_pct = row.inputs[6];
+    test.ID_mmh = row.inputs[7];
+    test.WDEL_pct = row.inputs[8];
+    test.CUC_pct = row.inputs[9];
+}
+
+// Function to open a feature cache for reading; fails if it is missing or was written by
+// a different format or derivation version
+bool openFeatureCache(FeatureCacheReader& reader, const std::string& cache_file) {
+    reader.file.open(cache_file, std::ios::binary);
+    if (!reader.file.is_open()) {
+        return false;
+    }
+    
+    FeatureCacheHeader header;
+    bool valid = reader.file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+                 std::equal(header.magic, header.magic + 8, FEATURE_CACHE_MAGIC) &&
+                 header.format_version == FEATURE_CACHE_FORMAT &&
+                 header.derivation_version == DERIVATION_VERSION &&
+                 header.row_size == sizeof(FeatureCacheRow);
+    if (!valid) {
+        reader.file.close();
+        return false;
+    }
+    reader.buffer.resize(4096);
+    return true;
+}
+
+// Function to peek at the next cached row, refilling the buffer as needed
+const FeatureCacheRow* peekFeatureRow(FeatureCacheReader& reader) {
+    if (reader.next == reader.filled) {
+        reader.file.read(reinterpret_cast<char*>(reader.buffer.data()),
+                         reader.buffer.size() * sizeof(FeatureCacheRow));
+        reader.filled = static_cast<size_t>(reader.file.gcount()) / sizeof(FeatureCacheRow);
+        reader.next = 0;
+        if (reader.filled == 0) {
+            return nullptr;
         }
-        
-        // Parse CSV line
-        std::vector<std::string> tokens = split(line, ',');
-        if (tokens.size() >= 11) {
-            TestData test;
-            test.test_id = tokens[0];
-            test.D_mm = std::stod(tokens[1]);
-            test.d_mm = std::stod(tokens[2]);
-            test.p_kPa = std::stod(tokens[3]);
-            test.V_ms = std::stod(tokens[4]);
-            test.Vp_ms = std::stod(tokens[5]);
-            test.T_C = std::stod(tokens[6]);
-            test.HR_pct = std::stod(tokens[7]);
-            test.ID_mmh = std::stod(tokens[8]);
-            test.WDEL_pct = std::stod(tokens[9]);
-            test.CUC_pct = std::stod(tokens[10]);
-            
-            data.push_back(test);
+    }
+    return &reader.buffer[reader.next];
+}
+
+// Function to take the cached row recorded for the data line at offset, if any; the caller
+// still has to compare the row's line hash before using it
+bool takeFeatureRow(FeatureCacheReader& reader, uint64_t offset, FeatureCacheRow& row) {
+    const FeatureCacheRow* cached;
+    while ((cached = peekFeatureRow(reader)) != nullptr && cached->offset < offset) {
+        reader.next++;
+        reader.stale = true;
+    }
+    if (!cached || cached->offset != offset) {
+        return false;
+    }
+    
+    reader.next++;
+    row = *cached;
+    return true;
+}
+
+// Function to position a cache reader at the first row whose line starts at or after offset
+void seekFeatureCache(FeatureCacheReader& reader, uint64_t offset) {
+    reader.file.clear();
+    reader.file.seekg(0, std::ios::end);
+    uint64_t rows = (static_cast<uint64_t>(reader.file.tellg()) - sizeof(FeatureCacheHeader)) /
+                    sizeof(FeatureCacheRow);
+    
+    // Rows are in file order, so binary search on their line offsets
+    uint64_t low = 0, high = rows;
+    while (low < high) {
+        uint64_t mid = low + (high - low) / 2;
+        uint64_t row_offset = 0;
+        reader.file.seekg(sizeof(FeatureCacheHeader) + mid * sizeof(FeatureCacheRow));
+        reader.file.read(reinterpret_cast<char*>(&row_offset), sizeof(row_offset));
+        if (row_offset < offset) {
+            low = mid + 1;
+        } else {
+            high = mid;
         }
     }
     
-    file.close();
-    std::cout << "Loaded " << data.size() << " test cases from " << filename << std::endl;
-    return data;
+    reader.file.seekg(sizeof(FeatureCacheHeader) + low * sizeof(FeatureCacheRow));
+    reader.next = 0;
+    reader.filled = 0;
+}
+
+// Function to start writing a feature cache (to a temporary file renamed on completion)
+bool beginFeatureCache(std::ofstream& file, const std::string& tmp_file) {
+    file.open(tmp_file, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    FeatureCacheHeader header = {};
+    std::copy(FEATURE_CACHE_MAGIC, FEATURE_CACHE_MAGIC + 8, header.magic);
+    header.format_version = FEATURE_CACHE_FORMAT;
+    header.derivation_version = DERIVATION_VERSION;
+    header.row_size = sizeof(FeatureCacheRow);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return true;
+}
+
+// Function to append one row to a cache being written
+void writeFeatureRow(std::ofstream& file, const FeatureCacheRow& row) {
+    file.write(reinterpret_cast<const char*>(&row), sizeof(row));
+}
+
+// Streaming accumulator for performance metrics (single pass, constant memory).
+// MAE, RMSE and MBE are the same sequential sums as the former two-pass calculation;
+// r and R² use running (Welford) deviations instead of deviations from a precomputed
+// mean, so on large inputs they can differ from the two-pass values in the last
+// printed digit (e.g. R² -703730915.480 vs -703730915.481 on a 1M-row file).
+struct MetricsAccumulator {
+    size_t n = 0;
+    double sum_abs_errors = 0;      // Sum of |predicted - measured|
+    double sum_squared_errors = 0;  // Sum of (predicted - measured)^2
+    double sum_errors = 0;          // Sum of (predicted - measured)
+    double mean_measured = 0;       // Running mean of measured values
+    double mean_predicted = 0;      // Running mean of predicted values
+    double m2_measured = 0;         // Sum of squared deviations of measured values
+    double m2_predicted = 0;        // Sum of squared deviations of predicted values
+    double co_moment = 0;           // Sum of cross deviations (measured x predicted)
+};
+
+// Add one measured/predicted pair (Welford update of means and co-moments)
+void accumulateMetrics(MetricsAccumulator& acc, double measured, double predicted) {
+    double error = predicted - measured;
+    acc.n++;
+    acc.sum_abs_errors += std::abs(error);
+    acc.sum_squared_errors += error * error;
+    acc.sum_errors += error;
+    
+    double diff_measured = measured - acc.mean_measured;
+    double diff_predicted = predicted - acc.mean_predicted;
+    acc.mean_measured += diff_measured / acc.n;
+    acc.mean_predicted += diff_predicted / acc.n;
+    acc.m2_measured += diff_measured * (measured - acc.mean_measured);
+    acc.m2_predicted += diff_predicted * (predicted - acc.mean_predicted);
+    acc.co_moment += diff_measured * (predicted - acc.mean_predicted);
+}
+
+// Merge a partial accumulator into another (pairwise update of Chan et al.)
+void mergeMetrics(MetricsAccumulator& acc, const MetricsAccumulator& other) {
+    if (other.n == 0) {
+        return;
+    }
+    if (acc.n == 0) {
+        acc = other;
+        return;
+    }
+    
+    double n_a = static_cast<double>(acc.n);
+    double n_b = static_cast<double>(other.n);
+    double n = n_a + n_b;
+    double diff_measured = other.mean_measured - acc.mean_measured;
+    double diff_predicted = other.mean_predicted - acc.mean_predicted;
+    
+    acc.n += other.n;
+    acc.sum_abs_errors += other.sum_abs_errors;
+    acc.sum_squared_errors += other.sum_squared_errors;
+    acc.sum_errors += other.sum_errors;
+    acc.m2_measured += other.m2_measured + diff_measured * diff_measured * n_a * n_b / n;
+    acc.m2_predicted += other.m2_predicted + diff_predicted * diff_predicted * n_a * n_b / n;
+    acc.co_moment += other.co_moment + diff_measured * diff_predicted * n_a * n_b / n;
+    acc.mean_measured += diff_measured * n_b / n;
+    acc.mean_predicted += diff_predicted * n_b / n;
+}
+
+// Check that two accumulators over the same records agree up to summation-order rounding
+bool metricsConsistent(const MetricsAccumulator& a, const MetricsAccumulator& b) {
+    const double tolerance = 1e-9;
+    const double pairs[3][2] = {
+        { a.sum_abs_errors, b.sum_abs_errors },
+        { a.sum_squared_errors, b.sum_squared_errors },
+        { a.m2_measured, b.m2_measured }
+    };
+    for (const double* pair : pairs) {
+        if (std::abs(pair[0] - pair[1]) > tolerance * std::max(std::abs(pair[0]), std::abs(pair[1]))) {
+            return false;
+        }
+    }
+    return a.n == b.n;
 }
 
 // Calculate performance metrics
-PerformanceMetrics calculateMetrics(const std::vector<double>& measured, const std::vector<double>& predicted) {
+PerformanceMetrics calculateMetrics(const MetricsAccumulator& acc) {
     PerformanceMetrics metrics;
-    int n = measured.size();
+    double n = static_cast<double>(acc.n);
+    
+    metrics.mae = acc.sum_abs_errors / n;
+    metrics.rmse = std::sqrt(acc.sum_squared_errors / n);
+    metrics.mbe = acc.sum_errors / n;
+    metrics.correlation = acc.co_moment / std::sqrt(acc.m2_measured * acc.m2_predicted);
+    metrics.r_squared = 1 - (acc.sum_squared_errors / acc.m2_measured);
     
-    // Calculate errors
-    std::vector<double> errors(n);
-    for (int i = 0; i < n; i++) {
-        errors[i] = predicted[i] - measured[i];
+    return metrics;
+}
+
+// Write the results file header
+void writeReportHeader(std::ofstream& outfile, const std::string& data_source) {
+    outfile << "WDEL Formula 2 (Aminpour et al. 2023) Evaluation Results - C++ Version\n";
+    outfile << "Using experimental data from Sanchez et al. (2011)\n";
+    outfile << "Data loaded from: " << data_source << "\n";
+    outfile << "======================================================\n\n";
+    
+    outfile << "Test Results:\n";
+    outfile << std::setw(12) << "Test ID" << std::setw(10) << "Measured" 
+            << std::setw(10) << "Predicted" << std::setw(10) << "Error" << "\n";
+    outfile << std::setw(12) << "--------" << std::setw(10) << "--------" 
+            << std::setw(10) << "---------" << std::setw(10) << "-----" << "\n";
+}
+
+// Format one test result as its console block and results file row
+void writeTestResult(std::ostream& console, std::ostream& outfile, const TestData& test, double predicted_pct) {
+    console << "Test " << test.test_id << ":\n";
+    console << "  Inputs: D=" << std::fixed << std::setprecision(1) << test.D_mm 
+              << "mm, d=" << test.d_mm << "mm, p=" << std::setprecision(0) 
+              << test.p_kPa << "kPa, V=" << std::setprecision(1) << test.V_ms 
+              << "m/s, T=" << std::setprecision(0) << test.T_C << "°C, HR=" 
+              << test.HR_pct << "%\n";
+    console << "  Measured WDEL: " << std::setprecision(1) << test.WDEL_pct << "%\n";
+    console << "  Predicted WDEL: " << predicted_pct << "%\n";
+    console << "  Error: " << std::abs(predicted_pct - test.WDEL_pct) << "%\n\n";
+    
+    double error = predicted_pct - test.WDEL_pct;
+    outfile << std::setw(12) << test.test_id 
+            << std::setw(10) << std::fixed << std::setprecision(1) << test.WDEL_pct
+            << std::setw(10) << predicted_pct 
+            << std::setw(10) << error << "\n";
+}
+
+// Write performance metrics to a stream
+void reportMetrics(std::ostream& out, const PerformanceMetrics& metrics) {
+    out << "Performance Metrics:\n";
+    out << "===================\n";
+    out << std::fixed << std::setprecision(2);
+    out << "Mean Absolute Error (MAE): " << metrics.mae << "%\n";
+    out << "Root Mean Square Error (RMSE): " << metrics.rmse << "%\n";
+    out << "Mean Bias Error (MBE): " << metrics.mbe << "%\n";
+    out << std::setprecision(3);
+    out << "Correlation Coefficient (r): " << metrics.correlation << "\n";
+    out << "Coefficient of Determination (R²): " << metrics.r_squared << "\n";
+}
+
+// Bounded lock-free multi-producer/multi-consumer queue (Vyukov ring buffer)
+template <typename T>
+class BoundedQueue {
+public:
+    // Capacity is rounded up to a power of two
+    explicit BoundedQueue(size_t capacity) : enqueue_pos_(0), dequeue_pos_(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        cells_.reset(new Cell[size]);
+        mask_ = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
     }
     
-    // Mean Absolute Error
-    double sum_abs_errors = 0;
-    for (double error : errors) {
-        sum_abs_errors += std::abs(error);
+    bool tryPush(const T& value) {
+        Cell* cell;
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
     }
-    metrics.mae = sum_abs_errors / n;
     
-    // Root Mean Square Error
-    double sum_squared_errors = 0;
-    for (double error : errors) {
-        sum_squared_errors += error * error;
+    bool tryPop(T& value) {
+        Cell* cell;
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // empty
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        value = cell->value;
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
     }
-    metrics.rmse = std::sqrt(sum_squared_errors / n);
     
-    // Mean Bias Error
-    double sum_errors = 0;
-    for (double error : errors) {
-        sum_errors += error;
+    // Blocking push/pop: spin briefly on the lock-free path, then sleep until the other side
+    // signals, so idle stages do not occupy a core
+    void push(const T& value) {
+        for (int spin = 0; spin < SPIN_LIMIT; spin++) {
+            if (tryPush(value)) {
+                wake(pop_waiters_, not_empty_);
+                return;
+            }
+            std::this_thread::yield();
+        }
+        wait(push_waiters_, not_full_, [&] { return tryPush(value); });
+        wake(pop_waiters_, not_empty_);
     }
-    metrics.mbe = sum_errors / n;
     
-    // Correlation coefficient
-    double mean_measured = 0, mean_predicted = 0;
-    for (int i = 0; i < n; i++) {
-        mean_measured += measured[i];
-        mean_predicted += predicted[i];
+    T pop() {
+        T value;
+        for (int spin = 0; spin < SPIN_LIMIT; spin++) {
+            if (tryPop(value)) {
+                wake(push_waiters_, not_full_);
+                return value;
+            }
+            std::this_thread::yield();
+        }
+        wait(pop_waiters_, not_empty_, [&] { return tryPop(value); });
+        wake(push_waiters_, not_full_);
+        return value;
     }
-    mean_measured /= n;
-    mean_predicted /= n;
     
-    double numerator = 0, denom_measured = 0, denom_predicted = 0;
-    for (int i = 0; i < n; i++) {
-        double diff_measured = measured[i] - mean_measured;
-        double diff_predicted = predicted[i] - mean_predicted;
-        numerator += diff_measured * diff_predicted;
-        denom_measured += diff_measured * diff_measured;
-        denom_predicted += diff_predicted * diff_predicted;
+private:
+    static const int SPIN_LIMIT = 64;
+    
+    // Register as a waiter before re-checking, so a concurrent push/pop either sees the
+    // waiter and notifies, or the re-check sees its effect
+    template <typename Ready>
+    void wait(std::atomic<int>& waiters, std::condition_variable& cond, Ready ready) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cond.wait(lock, ready);
+        waiters.fetch_sub(1);
     }
-    metrics.correlation = numerator / std::sqrt(denom_measured * denom_predicted);
     
-    // Coefficient of determination (R²)
-    double ss_res = sum_squared_errors;
-    double ss_tot = 0;
-    for (int i = 0; i < n; i++) {
-        double diff = measured[i] - mean_measured;
-        ss_tot += diff * diff;
+    void wake(std::atomic<int>& waiters, std::condition_variable& cond) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load() > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cond.notify_all();
+        }
     }
-    metrics.r_squared = 1 - (ss_res / ss_tot);
     
-    return metrics;
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueue_pos_;
+    alignas(64) std::atomic<size_t> dequeue_pos_;
+    
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::atomic<int> push_waiters_{0};
+    std::atomic<int> pop_waiters_{0};
+};
+
+// Pipeline sizing: memory in flight is bounded by BATCHES_PER_WORKER * workers * BATCH_SIZE records
+const size_t BATCH_SIZE = 256;          // Records per batch
+const size_t BATCHES_PER_WORKER = 2;    // Batches in flight per evaluation worker
+
+// Fixed-size batch of records passed between pipeline stages
+struct RecordBatch {
+    size_t sequence;                    // Position of the batch in the input
+    size_t count;                       // Number of valid records
+    std::vector<std::string> lines;     // Raw CSV lines read by the parser
+    std::vector<uint64_t> offsets;      // Byte offset of each line
+    std::vector<FeatureCacheRow> cached_rows;  // Cache row recorded for each line, if any
+    std::vector<char> has_cached_row;   // Whether cached_rows[i] was found
+    std::vector<char> cache_in_order;   // Whether no old cache rows were skipped up to line i
+    std::vector<char> valid;            // Whether line i parsed as a record (set by workers)
+    std::vector<TestData> records;      // Parsed test data (BATCH_SIZE slots, reused)
+    std::vector<uint64_t> line_hashes;  // hashLine() of each line (cache in use only)
+    std::vector<char> has_features;     // Whether features[i] came from a matching cache row
+    FeatureColumns features;            // Derived features aligned with records
+    std::vector<double> predicted_pct;  // Predicted WDEL (%)
+    std::string console_text;           // Formatted console blocks of the valid records
+    std::string file_text;              // Formatted results file rows of the valid records
+    std::vector<size_t> console_end;    // End of record i's block in console_text
+    std::vector<size_t> file_end;       // End of record i's row in file_text
+};
+
+// Byte range of a data file evaluated as one unit of work; a record belongs to the
+// shard in which its line starts
+struct ShardSpec {
+    std::string data_file;
+    uint64_t begin;
+    uint64_t end;
+};
+
+// Function to get the size of a file in bytes (0 if it cannot be opened)
+uint64_t fileSize(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return 0;
+    }
+    return static_cast<uint64_t>(file.tellg());
 }
 
-int main() {
-    // Load test data from external file
-    std::string data_file = "../data/experimental_data.txt";
-    std::vector<TestData> test_data = loadTestData(data_file);
+// Function to split data files into shards of roughly equal size
+std::vector<ShardSpec> planShards(const std::vector<std::string>& data_files, size_t n_shards) {
+    uint64_t total_bytes = 0;
+    for (const std::string& data_file : data_files) {
+        total_bytes += fileSize(data_file);
+    }
+    uint64_t target = std::max<uint64_t>(1, (total_bytes + n_shards - 1) / n_shards);
     
-    if (test_data.empty()) {
-        std::cerr << "No test data loaded. Exiting." << std::endl;
-        return 1;
+    std::vector<ShardSpec> shards;
+    for (const std::string& data_file : data_files) {
+        uint64_t size = fileSize(data_file);
+        uint64_t begin = 0;
+        do {
+            ShardSpec shard = { data_file, begin, std::min(size, begin + target) };
+            shards.push_back(shard);
+            begin = shard.end;
+        } while (begin < size);
     }
+    return shards;
+}
+
+// Function to parse a non-negative decimal integer; rejects empty or non-numeric text
+bool parseUnsigned(const std::string& text, uint64_t& value) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    value = std::strtoull(text.c_str(), nullptr, 10);
+    return true;
+}
+
+// Partial results file: header, then per record a line "<measured %a> <predicted %a>
+// <file_bytes> <console_bytes>" followed by the record's finished results file row and
+// console block, and a metrics trailer holding the shard's accumulator as exact hex floats
+const std::string PARTIAL_MAGIC = "# WDEL partial results v2";
+const std::string PARTIAL_SHARD_KEY = "# shard=";
+const std::string PARTIAL_METRICS_KEY = "# metrics=";
+
+
+// Function to write the metrics trailer of a partial results file
+void writePartialMetrics(std::ofstream& file, const MetricsAccumulator& acc) {
+    char trailer[512];
+    std::snprintf(trailer, sizeof(trailer), "%llu %a %a %a %a %a %a %a %a",
+                  static_cast<unsigned long long>(acc.n), acc.sum_abs_errors,
+                  acc.sum_squared_errors, acc.sum_errors, acc.mean_measured,
+                  acc.mean_predicted, acc.m2_measured, acc.m2_predicted, acc.co_moment);
+    file << PARTIAL_METRICS_KEY << trailer << "\n";
+}
+
+// Function to parse the metrics trailer of a partial results file
+bool parsePartialMetrics(const std::string& line, MetricsAccumulator& acc) {
+    std::vector<std::string> tokens = split(line.substr(PARTIAL_METRICS_KEY.size()), ' ');
+    if (tokens.size() != 9) {
+        return false;
+    }
+    double* fields[8] = { &acc.sum_abs_errors, &acc.sum_squared_errors, &acc.sum_errors,
+                          &acc.mean_measured, &acc.mean_predicted, &acc.m2_measured,
+                          &acc.m2_predicted, &acc.co_moment };
+    for (size_t i = 0; i < 8; i++) {
+        char* end;
+        *fields[i] = std::strtod(tokens[i + 1].c_str(), &end);
+        if (end == tokens[i + 1].c_str() || *end != '\0') {
+            return false;
+        }
+    }
+    uint64_t n = 0;
+    if (!parseUnsigned(tokens[0], n)) {
+        return false;
+    }
+    acc.n = static_cast<size_t>(n);
+    return true;
+}
+
+// State shared by the parser, evaluation workers and writer
+struct PipelineContext {
+    ShardSpec shard;
+    size_t n_workers;
+    std::vector<RecordBatch> batches;       // Preallocated batch pool
+    BoundedQueue<RecordBatch*> free_batches; // parser <- writer
+    BoundedQueue<RecordBatch*> parsed;       // parser -> workers (nullptr ends a worker)
+    BoundedQueue<RecordBatch*> evaluated;    // workers -> writer (nullptr: input exhausted)
+    std::atomic<size_t> total_batches;       // Set by the parser once input is exhausted
     
-    int n_tests = test_data.size();
-    std::vector<double> measured_wdel(n_tests);
-    std::vector<double> predicted_wdel(n_tests);
+    FeatureCacheReader cache_in;             // Valid feature cache being read, if any
+    std::ofstream cache_out;                 // Feature cache being rebuilt, if any (writer)
+    bool may_rebuild_cache;                  // Whole-file runs rebuild a stale cache in-pass
+    bool hash_lines;                         // Lines are hashed when a cache is read or rebuilt
+    std::string cache_file;
+    std::string cache_tmp_file;
+    size_t cache_prefix_rows;                // Old cache rows still valid before the first change
+    std::ofstream* report;                   // Results file for the final report, if any
+    std::ofstream* partial;                  // Partial results file for a shard, if any
+    MetricsAccumulator& metrics;             // Owned by the writer
+    size_t record_count;                     // Owned by the writer
     
-    std::cout << "Evaluation of WDEL Formula 2 (Aminpour et al. 2023) - C++ Version\n";
-    std::cout << "Using experimental data from Sanchez et al. (2011)\n";
-    std::cout << "=======================================================\n\n";
+    PipelineContext(const ShardSpec& spec, size_t workers, std::ofstream* results,
+                    std::ofstream* partial_results, MetricsAccumulator& acc)
+        : shard(spec), n_workers(workers), batches(workers * BATCHES_PER_WORKER + 2),
+          free_batches(batches.size()), parsed(batches.size() + workers),
+          evaluated(batches.size() + 1), total_batches(SIZE_MAX), may_rebuild_cache(false),
+          hash_lines(false),
+          cache_prefix_rows(0), report(results), partial(partial_results), metrics(acc),
+          record_count(0) {
+        for (RecordBatch& batch : batches) {
+            batch.lines.resize(BATCH_SIZE);
+            batch.offsets.resize(BATCH_SIZE);
+            batch.cached_rows.resize(BATCH_SIZE);
+            batch.has_cached_row.resize(BATCH_SIZE);
+            batch.cache_in_order.resize(BATCH_SIZE);
+            batch.valid.resize(BATCH_SIZE);
+            batch.records.resize(BATCH_SIZE);
+            batch.line_hashes.resize(BATCH_SIZE);
+            batch.has_features.resize(BATCH_SIZE);
+            batch.features.resize(BATCH_SIZE);
+            batch.predicted_pct.resize(BATCH_SIZE);
+            batch.console_end.resize(BATCH_SIZE);
+            batch.file_end.resize(BATCH_SIZE);
+            free_batches.push(&batch);
+        }
+    }
+};
+
+// Parser stage: read the shard's lines into batches, attaching any cache row recorded for
+// each line; parsing and cache validation are left to the evaluation workers
+void parserStage(PipelineContext& ctx) {
+    std::ifstream file(ctx.shard.data_file, std::ios::binary);
+    std::string line;
+    size_t sequence = 0;
+    RecordBatch* batch = nullptr;
     
-    // Process each test case
-    for (int i = 0; i < n_tests; i++) {
-        TestData& test = test_data[i];
-        
-        // Convert units for formula input
-        double Dn = test.D_mm / 1000.0;        // Main nozzle diameter (m)
-        double d = test.d_mm / 1000.0;         // Secondary nozzle diameter (m)
-        double U = test.V_ms;                  // Wind speed (m/s)
-        double h = 1.0;                        // Assume sprinkler height of 1.0 m
-        double P_kPa = test.p_kPa;             // Pressure (kPa)
-        double RH = test.HR_pct / 100.0;       // Relative humidity (fraction)
+    // Skip the line straddling the shard start; it belongs to the previous shard
+    uint64_t offset = 0;
+    if (ctx.shard.begin > 0) {
+        file.seekg(ctx.shard.begin - 1);
+        std::getline(file, line);
+        offset = ctx.shard.begin + line.size();
+    }
+    
+    bool reading_cache = ctx.cache_in.file.is_open();
+    while (offset < ctx.shard.end) {
+        if (!batch) {
+            batch = ctx.free_batches.pop();
+            batch->count = 0;
+        }
+        size_t i = batch->count;
+        std::string& current = batch->lines[i];
+        if (!std::getline(file, current)) {
+            break;
+        }
+        uint64_t line_offset = offset;
+        offset += current.size() + 1;
         
-        // Estimate solar radiation based on temperature
-        double SR = 200 + (test.T_C - 5) * 20;
-        SR = std::max(200.0, std::min(800.0, SR));
+        // Skip comment lines and empty lines
+        if (current.empty() || current[0] == '#') {
+            continue;
+        }
+        batch->offsets[i] = line_offset;
+        batch->has_cached_row[i] = reading_cache &&
+                                   takeFeatureRow(ctx.cache_in, line_offset, batch->cached_rows[i]);
+        batch->cache_in_order[i] = reading_cache && !ctx.cache_in.stale;
         
-        // Calculate WDEL using formula
-        double loss_fraction = wdel_aminpour2023(d, Dn, U, h, P_kPa, RH, SR);
-        double predicted_pct = loss_fraction * 100;
+        if (++batch->count == BATCH_SIZE) {
+            batch->sequence = sequence++;
+            ctx.parsed.push(batch);
+            batch = nullptr;
+        }
+    }
+    
+    if (batch && batch->count > 0) {
+        batch->sequence = sequence++;
+        ctx.parsed.push(batch);
+    } else if (batch) {
+        ctx.free_batches.push(batch);
+    }
+    
+    // Publish the batch count, then wake the writer in case it is waiting for more batches
+    ctx.total_batches.store(sequence, std::memory_order_release);
+    ctx.evaluated.push(nullptr);
+    for (size_t w = 0; w < ctx.n_workers; w++) {
+        ctx.parsed.push(nullptr);
+    }
+}
+
+// Evaluation stage: parse each line (or decode its cache row when the line hash still
+// matches), derive missing features and evaluate the formula
+void workerStage(PipelineContext& ctx) {
+    std::ostringstream console, file;
+    for (;;) {
+        RecordBatch* batch = ctx.parsed.pop();
+        if (!batch) {
+            break;
+        }
         
-        // Store results
-        measured_wdel[i] = test.WDEL_pct;
-        predicted_wdel[i] = predicted_pct;
+        FeatureColumns& f = batch->features;
+        console.str("");
+        file.str("");
+        for (size_t i = 0; i < batch->count; i++) {
+            const std::string& line = batch->lines[i];
+            TestData& test = batch->records[i];
+            uint64_t line_hash = ctx.hash_lines ? hashLine(line) : 0;
+            batch->line_hashes[i] = line_hash;
+            
+            // A current cache row replaces CSV parsing and feature derivation for this line
+            const FeatureCacheRow& row = batch->cached_rows[i];
+            batch->has_features[i] = batch->has_cached_row[i] && row.line_hash == line_hash;
+            if (batch->has_features[i]) {
+                test.test_id.assign(line, 0, line.find(','));
+                loadCachedInputs(row, test);
+                f.set(i, row.features);
+            } else if (parseTestLine(line, test)) {
+                f.set(i, deriveFeatures(test));
+            } else {
+                batch->valid[i] = false;
+                batch->console_end[i] = static_cast<size_t>(console.tellp());
+                batch->file_end[i] = static_cast<size_t>(file.tellp());
+                continue;
+            }
+            batch->valid[i] = true;
+            
+            double loss_fraction = wdel_aminpour2023_groups(f.pi1[i], f.pi2[i], f.pi3[i],
+                                                            f.pi4[i], f.pi5[i]);
+            batch->predicted_pct[i] = loss_fraction * 100;
+            
+            // Report text is formatted here so the serial writer only copies it out
+            writeTestResult(console, file, test, batch->predicted_pct[i]);
+            batch->console_end[i] = static_cast<size_t>(console.tellp());
+            batch->file_end[i] = static_cast<size_t>(file.tellp());
+        }
+        batch->console_text = console.str();
+        batch->file_text = file.str();
+        ctx.evaluated.push(batch);
+    }
+}
+
+// Function to append one formatted record of a batch to a partial results file
+void writePartialRecord(std::ofstream& file, const RecordBatch& batch, size_t i) {
+    size_t console_begin = i > 0 ? batch.console_end[i - 1] : 0;
+    size_t file_begin = i > 0 ? batch.file_end[i - 1] : 0;
+    size_t console_bytes = batch.console_end[i] - console_begin;
+    size_t file_bytes = batch.file_end[i] - file_begin;
+    
+    char header[128];
+    std::snprintf(header, sizeof(header), "%a %a %zu %zu\n", batch.records[i].WDEL_pct,
+                  batch.predicted_pct[i], file_bytes, console_bytes);
+    file << header;
+    file.write(batch.file_text.data() + file_begin, file_bytes);
+    file.write(batch.console_text.data() + console_begin, console_bytes);
+}
+
+// Start writing a replacement cache, carrying over the old cache's valid leading rows
+void startCacheRebuild(PipelineContext& ctx) {
+    if (!beginFeatureCache(ctx.cache_out, ctx.cache_tmp_file)) {
+        ctx.may_rebuild_cache = false;
+        std::cerr << "Warning: Could not write feature cache: " << ctx.cache_file << std::endl;
+        return;
+    }
+    
+    std::ifstream old_cache(ctx.cache_file, std::ios::binary);
+    old_cache.seekg(sizeof(FeatureCacheHeader));
+    std::vector<char> buffer(4096 * sizeof(FeatureCacheRow));
+    uint64_t remaining = ctx.cache_prefix_rows * sizeof(FeatureCacheRow);
+    while (remaining > 0 && old_cache.read(buffer.data(), std::min<uint64_t>(remaining, buffer.size()))) {
+        ctx.cache_out.write(buffer.data(), old_cache.gcount());
+        remaining -= old_cache.gcount();
+    }
+    if (remaining > 0) {
+        ctx.cache_out.setstate(std::ios::failbit);
+    }
+}
+
+// Writer stage: emit batches in input order, accumulate metrics and recycle batches
+void writerStage(PipelineContext& ctx) {
+    // Batches finishing out of order wait here; sequences in flight never exceed the pool size
+    std::vector<RecordBatch*> pending(ctx.batches.size(), nullptr);
+    size_t next = 0;
+    FeatureCacheRow row;
+    
+    while (next != ctx.total_batches.load(std::memory_order_acquire)) {
+        // A null batch only signals that total_batches is now set
+        RecordBatch* batch = ctx.evaluated.pop();
+        if (!batch) {
+            continue;
+        }
+        pending[batch->sequence % pending.size()] = batch;
         
-        // Display results
-        std::cout << "Test " << test.test_id << ":\n";
-        std::cout << "  Inputs: D=" << std::fixed << std::setprecision(1) << test.D_mm 
-                  << "mm, d=" << test.d_mm << "mm, p=" << std::setprecision(0) 
-                  << test.p_kPa << "kPa, V=" << std::setprecision(1) << test.V_ms 
-                  << "m/s, T=" << std::setprecision(0) << test.T_C << "°C, HR=" 
-                  << test.HR_pct << "%\n";
-        std::cout << "  Measured WDEL: " << std::setprecision(1) << test.WDEL_pct << "%\n";
-        std::cout << "  Predicted WDEL: " << predicted_pct << "%\n";
-        std::cout << "  Error: " << std::abs(predicted_pct - test.WDEL_pct) << "%\n\n";
+        size_t valid_count = 0;
+        while ((batch = pending[next % pending.size()]) != nullptr) {
+            pending[next % pending.size()] = nullptr;
+            for (size_t i = 0; i < batch->count; i++) {
+                if (!batch->valid[i]) {
+                    continue;
+                }
+                valid_count++;
+                const TestData& test = batch->records[i];
+                if (ctx.partial) {
+                    writePartialRecord(*ctx.partial, *batch, i);
+                }
+                accumulateMetrics(ctx.metrics, test.WDEL_pct, batch->predicted_pct[i]);
+                
+                // Records matching the old cache in order need no new rows until the first
+                // change; from there the cache is rebuilt in this same pass
+                if (ctx.may_rebuild_cache && !ctx.cache_out.is_open()) {
+                    if (batch->cache_in_order[i] && batch->has_features[i]) {
+                        ctx.cache_prefix_rows++;
+                    } else {
+                        startCacheRebuild(ctx);
+                    }
+                }
+                if (ctx.cache_out.is_open()) {
+                    row.offset = batch->offsets[i];
+                    row.line_hash = batch->line_hashes[i];
+                    storeCachedInputs(row, test);
+                    row.features = batch->features.get(i);
+                    writeFeatureRow(ctx.cache_out, row);
+                }
+            }
+            if (ctx.report) {
+                std::cout << batch->console_text;
+                *ctx.report << batch->file_text;
+            }
+            ctx.free_batches.push(batch);
+            next++;
+        }
+        ctx.record_count += valid_count;
+    }
+}
+
+// Run parser -> evaluation workers -> writer over one shard; returns records evaluated.
+// Records are streamed to the report and/or partial file and folded into metrics.
+size_t runEvaluationPipeline(const ShardSpec& shard, size_t n_workers, std::ofstream* report,
+                             std::ofstream* partial, MetricsAccumulator& metrics) {
+    PipelineContext ctx(shard, n_workers, report, partial, metrics);
+    
+    // Byte-range shards read their slice of an existing cache; only whole-file runs build,
+    // replace or remove it, so concurrent shard workers never write the same cache
+    std::string cache_file = shard.data_file + ".features";
+    std::string tmp_file = cache_file + ".tmp";
+    ctx.cache_file = cache_file;
+    ctx.cache_tmp_file = tmp_file;
+    ctx.may_rebuild_cache = shard.begin == 0 && shard.end >= fileSize(shard.data_file);
+    ctx.hash_lines = ctx.may_rebuild_cache;
+    if (openFeatureCache(ctx.cache_in, cache_file)) {
+        if (shard.begin > 0) {
+            seekFeatureCache(ctx.cache_in, shard.begin);
+        }
+        std::clog << "Loading derived features from " << cache_file << std::endl;
+        ctx.hash_lines = true;
+    } else if (ctx.may_rebuild_cache) {
+        startCacheRebuild(ctx);
+    }
+    
+    std::thread parser(parserStage, std::ref(ctx));
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < n_workers; w++) {
+        workers.push_back(std::thread(workerStage, std::ref(ctx)));
+    }
+    std::thread writer(writerStage, std::ref(ctx));
+    
+    parser.join();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    writer.join();
+    
+    // Rows left over after the last record (lines removed at the end) also need a rebuild
+    bool leftover_rows = ctx.cache_in.file.is_open() && peekFeatureRow(ctx.cache_in) != nullptr;
+    ctx.cache_in.file.close();
+    if (ctx.may_rebuild_cache && !ctx.cache_out.is_open() && leftover_rows) {
+        startCacheRebuild(ctx);
+    }
+    if (ctx.cache_out.is_open()) {
+        ctx.cache_out.close();
+        bool written = !ctx.cache_out.fail();
+        if (written && std::rename(tmp_file.c_str(), cache_file.c_str()) != 0) {
+            // Some platforms refuse to rename over an existing file
+            std::remove(cache_file.c_str());
+            written = std::rename(tmp_file.c_str(), cache_file.c_str()) == 0;
+        }
+        if (written) {
+            std::clog << "Saved derived features to " << cache_file << std::endl;
+        } else {
+            std::remove(tmp_file.c_str());
+            std::cerr << "Warning: Could not write feature cache: " << cache_file << std::endl;
+        }
+    }
+    
+    return ctx.record_count;
+}
+
+// Function to join data source names for the report header
+std::string joinSources(const std::vector<std::string>& sources) {
+    std::string joined;
+    for (size_t i = 0; i < sources.size(); i++) {
+        joined += (i > 0 ? ", " : "") + sources[i];
+    }
+    return joined;
+}
+
+// Open the results file and print the report banner
+bool beginReport(std::ofstream& outfile, const std::string& results_file,
+                 const std::vector<std::string>& sources) {
+    // Written to a temporary file and renamed by finishReport, so a failed run never
+    // leaves a half-written report in place of the previous one
+    outfile.open(results_file + ".tmp");
+    if (!outfile.is_open()) {
+        std::cerr << "Error: Could not open results file: " << results_file << ".tmp" << std::endl;
+        return false;
     }
     
+    std::cout << "Evaluation of WDEL Formula 2 (Aminpour et al. 2023) - C++ Version\n";
+    std::cout << "Using experimental data from Sanchez et al. (2011)\n";
+    std::cout << "=======================================================\n\n";
+    
+    writeReportHeader(outfile, joinSources(sources));
+    return true;
+}
+
+// Discard a report that could not be completed
+void abandonReport(std::ofstream& outfile, const std::string& results_file) {
+    outfile.close();
+    std::remove((results_file + ".tmp").c_str());
+}
+
+// Print and save performance metrics once all records have been reported
+int finishReport(std::ofstream& outfile, const std::string& results_file,
+                 const std::vector<std::string>& sources, const MetricsAccumulator& accumulator) {
+    if (accumulator.n == 0) {
+        abandonReport(outfile, results_file);
+        std::cerr << "No test data loaded. Exiting." << std::endl;
+        return 1;
+    }
+    std::cout << "Evaluated " << accumulator.n << " test cases from " << joinSources(sources) << "\n\n";
+    
     // Calculate performance metrics
-    PerformanceMetrics metrics = calculateMetrics(measured_wdel, predicted_wdel);
+    PerformanceMetrics metrics = calculateMetrics(accumulator);
     
     // Display performance metrics
-    std::cout << "Performance Metrics:\n";
-    std::cout << "===================\n";
-    std::cout << std::fixed << std::setprecision(2);
-    std::cout << "Mean Absolute Error (MAE): " << metrics.mae << "%\n";
-    std::cout << "Root Mean Square Error (RMSE): " << metrics.rmse << "%\n";
-    std::cout << "Mean Bias Error (MBE): " << metrics.mbe << "%\n";
-    std::cout << std::setprecision(3);
-    std::cout << "Correlation Coefficient (r): " << metrics.correlation << "\n";
-    std::cout << "Coefficient of Determination (R²): " << metrics.r_squared << "\n";
-    
-    // Save results to file
-    std::ofstream outfile("wdel_formula2_evaluation_results_cpp.txt");
-    outfile << "WDEL Formula 2 (Aminpour et al. 2023) Evaluation Results - C++ Version\n";
-    outfile << "Using experimental data from Sanchez et al. (2011)\n";
-    outfile << "Data loaded from: " << data_file << "\n";
-    outfile << "======================================================\n\n";
+    reportMetrics(std::cout, metrics);
     
-    outfile << "Test Results:\n";
-    outfile << std::setw(12) << "Test ID" << std::setw(10) << "Measured" 
-            << std::setw(10) << "Predicted" << std::setw(10) << "Error" << "\n";
-    outfile << std::setw(12) << "--------" << std::setw(10) << "--------" 
-            << std::setw(10) << "---------" << std::setw(10) << "-----" << "\n";
+    // Save metrics to results file
+    outfile << "\n";
+    reportMetrics(outfile, metrics);
+    outfile.close();
     
-    for (int i = 0; i < n_tests; i++) {
-        double error = predicted_wdel[i] - measured_wdel[i];
-        outfile << std::setw(12) << test_data[i].test_id 
-                << std::setw(10) << std::fixed << std::setprecision(1) << measured_wdel[i]
-                << std::setw(10) << predicted_wdel[i] 
-                << std::setw(10) << error << "\n";
+    std::string tmp_file = results_file + ".tmp";
+    bool saved = !outfile.fail();
+    if (saved && std::rename(tmp_file.c_str(), results_file.c_str()) != 0) {
+        // Some platforms refuse to rename over an existing file
+        std::remove(results_file.c_str());
+        saved = std::rename(tmp_file.c_str(), results_file.c_str()) == 0;
+    }
+    if (!saved) {
+        std::remove(tmp_file.c_str());
+        std::cerr << "Error: Could not write results file: " << results_file << std::endl;
+        return 1;
     }
     
-    outfile << "\nPerformance Metrics:\n";
-    outfile << "===================\n";
-    outfile << std::fixed << std::setprecision(2);
-    outfile << "Mean Absolute Error (MAE): " << metrics.mae << "%\n";
-    outfile << "Root Mean Square Error (RMSE): " << metrics.rmse << "%\n";
-    outfile << "Mean Bias Error (MBE): " << metrics.mbe << "%\n";
-    outfile << std::setprecision(3);
-    outfile << "Correlation Coefficient (r): " << metrics.correlation << "\n";
-    outfile << "Coefficient of Determination (R²): " << metrics.r_squared << "\n";
+    std::cout << "\nEvaluation complete. Results saved to \"" << results_file << "\"\n";
+    return 0;
+}
+
+// Evaluate all data files in this process, streaming results straight into the report
+int runSingleProcess(const std::vector<std::string>& data_files, const std::string& results_file,
+                     size_t n_workers) {
+    for (const std::string& data_file : data_files) {
+        if (!std::ifstream(data_file).is_open()) {
+            std::cerr << "Error: Could not open data file: " << data_file << std::endl;
+            std::cerr << "No test data loaded. Exiting." << std::endl;
+            return 1;
+        }
+    }
     
-    outfile.close();
+    // Results are streamed to file as batches complete, so memory use is independent of input size
+    std::ofstream outfile;
+    if (!beginReport(outfile, results_file, data_files)) {
+        return 1;
+    }
+    
+    MetricsAccumulator accumulator;
+    for (const std::string& data_file : data_files) {
+        ShardSpec shard = { data_file, 0, fileSize(data_file) };
+        runEvaluationPipeline(shard, n_workers, &outfile, nullptr, accumulator);
+    }
     
-    std::cout << "\nEvaluation complete. Results saved to \"wdel_formula2_evaluation_results_cpp.txt\"\n";
+    return finishReport(outfile, results_file, data_files, accumulator);
+}
+
+// Evaluate one shard and write its partial results (renamed into place only when complete)
+int runShard(const ShardSpec& shard, const std::string& part_file, size_t n_workers) {
+    if (!std::ifstream(shard.data_file).is_open()) {
+        std::cerr << "Error: Could not open data file: " << shard.data_file << std::endl;
+        return 1;
+    }
     
+    std::string tmp_file = part_file + ".tmp";
+    std::ofstream partial(tmp_file);
+    if (!partial.is_open()) {
+        std::cerr << "Error: Could not open partial results file: " << tmp_file << std::endl;
+        return 1;
+    }
+    partial << PARTIAL_MAGIC << "\n";
+    partial << PARTIAL_SHARD_KEY << shard.begin << " " << shard.end << " " << shard.data_file << "\n";
+    
+    MetricsAccumulator accumulator;
+    runEvaluationPipeline(shard, n_workers, nullptr, &partial, accumulator);
+    writePartialMetrics(partial, accumulator);
+    partial.close();
+    
+    if (partial.fail() || std::rename(tmp_file.c_str(), part_file.c_str()) != 0) {
+        std::remove(tmp_file.c_str());
+        std::cerr << "Error: Could not write partial results file: " << part_file << std::endl;
+        return 1;
+    }
     return 0;
 }
+
+// Function to check a partial results file's header and trailer before merging; returns
+// the data source it names
+bool checkPartialFile(const std::string& part_file, std::string& data_file) {
+    std::ifstream file(part_file, std::ios::binary);
+    std::string magic, shard_line;
+    if (!std::getline(file, magic) || magic != PARTIAL_MAGIC ||
+        !std::getline(file, shard_line) || shard_line.compare(0, PARTIAL_SHARD_KEY.size(), PARTIAL_SHARD_KEY) != 0) {
+        return false;
+    }
+    
+    // "<begin> <end> <data_file>"; the file name may itself contain spaces
+    size_t first = shard_line.find(' ', PARTIAL_SHARD_KEY.size());
+    size_t second = first == std::string::npos ? first : shard_line.find(' ', first + 1);
+    if (second == std::string::npos) {
+        return false;
+    }
+    data_file = shard_line.substr(second + 1);
+    
+    // A complete file ends with its metrics trailer
+    const std::streamoff tail_size = 512;
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    file.seekg(std::max<std::streamoff>(0, size - tail_size));
+    std::string tail(static_cast<size_t>(std::min(size, tail_size)), '\0');
+    file.read(&tail[0], tail.size());
+    size_t trailer = tail.rfind("\n" + PARTIAL_METRICS_KEY);
+    return trailer != std::string::npos && tail.find('\n', trailer + 1) == tail.size() - 1;
+}
+
+// Function to parse one partial record header "<measured %a> <predicted %a> <file_bytes> <console_bytes>"
+bool parsePartialRecord(const std::string& line, double& measured, double& predicted,
+                        size_t& file_bytes, size_t& console_bytes) {
+    const char* text = line.c_str();
+    char* end;
+    measured = std::strtod(text, &end);
+    if (end == text || *end != ' ') {
+        return false;
+    }
+    text = end;
+    predicted = std::strtod(text, &end);
+    if (end == text || *end != ' ') {
+        return false;
+    }
+    uint64_t sizes[2];
+    std::vector<std::string> tokens = split(end + 1, ' ');
+    if (tokens.size() != 2 || !parseUnsigned(tokens[0], sizes[0]) || !parseUnsigned(tokens[1], sizes[1]) ||
+        sizes[0] > (1u << 20) || sizes[1] > (1u << 20)) {
+        return false;
+    }
+    file_bytes = static_cast<size_t>(sizes[0]);
+    console_bytes = static_cast<size_t>(sizes[1]);
+    return true;
+}
+
+// Merge partial results, in the order given, into the final report
+int runMerge(const std::vector<std::string>& part_files, const std::string& results_file) {
+    // Check every part before touching the results file
+    std::vector<std::string> sources;
+    for (const std::string& part_file : part_files) {
+        std::string data_file;
+        if (!checkPartialFile(part_file, data_file)) {
+            std::cerr << "Error: Incomplete or corrupt partial results file: " << part_file << std::endl;
+            return 1;
+        }
+        if (sources.empty() || sources.back() != data_file) {
+            sources.push_back(data_file);
+        }
+    }
+    
+    std::ofstream outfile;
+    if (!beginReport(outfile, results_file, sources)) {
+        return 1;
+    }
+    
+    // The shards' formatted output is copied through unchanged; metrics are re-accumulated
+    // from the exact measured/predicted values in input order, which reproduces a
+    // single-process run bit for bit. The shards' own accumulators only cross-check the rows.
+    MetricsAccumulator accumulator, merged_partials;
+    std::string text;
+    for (const std::string& part_file : part_files) {
+        std::ifstream file(part_file, std::ios::binary);
+        std::string line;
+        size_t rows = 0;
+        bool complete = false;
+        while (!complete && std::getline(file, line)) {
+            if (line.compare(0, PARTIAL_METRICS_KEY.size(), PARTIAL_METRICS_KEY) == 0) {
+                MetricsAccumulator partial;
+                if (!parsePartialMetrics(line, partial) || partial.n != rows) {
+                    break;
+                }
+                mergeMetrics(merged_partials, partial);
+                complete = true;
+                continue;
+            }
+            if (line.compare(0, 2, "# ") == 0) {
+                continue;
+            }
+            
+            double measured_pct, predicted_pct;
+            size_t file_bytes, console_bytes;
+            if (!parsePartialRecord(line, measured_pct, predicted_pct, file_bytes, console_bytes)) {
+                break;
+            }
+            text.resize(file_bytes + console_bytes);
+            if (!file.read(&text[0], text.size())) {
+                break;
+            }
+            outfile.write(text.data(), file_bytes);
+            std::cout.write(text.data() + file_bytes, console_bytes);
+            accumulateMetrics(accumulator, measured_pct, predicted_pct);
+            rows++;
+        }
+        
+        if (!complete) {
+            abandonReport(outfile, results_file);
+            std::cerr << "Error: Incomplete or corrupt partial results file: " << part_file << std::endl;
+            return 1;
+        }
+    }
+    
+    if (!metricsConsistent(accumulator, merged_partials)) {
+        abandonReport(outfile, results_file);
+        std::cerr << "Error: Partial results rows do not match their metrics trailers" << std::endl;
+        return 1;
+    }
+    
+    return finishReport(outfile, results_file, sources, accumulator);
+}
+
+// Function to name the partial results file of a shard
+std::string partFileName(const std::string& results_file, size_t index) {
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), ".shard%04zu.part", index);
+    return results_file + suffix;
+}
+
+#ifdef WDEL_HAVE_PROCESSES
+// Function to find this program's executable, falling back to the name it was started as
+std::string selfPath(const char* argv0) {
+    char path[4096];
+#if defined(__APPLE__)
+    uint32_t size = sizeof(path);
+    if (_NSGetExecutablePath(path, &size) == 0) {
+        return path;
+    }
+#elif defined(__linux__)
+    ssize_t len = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (len > 0) {
+        return std::string(path, len);
+    }
+#endif
+    return argv0;
+}
+
+// Split the data files into shards, evaluate them in local worker processes and merge the results
+int runCoordinator(const std::string& self_path, const std::vector<std::string>& data_files,
+                   const std::string& results_file, size_t n_jobs, size_t n_workers) {
+    for (const std::string& data_file : data_files) {
+        if (!std::ifstream(data_file).is_open()) {
+            std::cerr << "Error: Could not open data file: " << data_file << std::endl;
+            return 1;
+        }
+    }
+    
+    std::vector<ShardSpec> shards = planShards(data_files, n_jobs);
+    std::vector<std::string> part_files;
+    for (size_t i = 0; i < shards.size(); i++) {
+        part_files.push_back(partFileName(results_file, i));
+    }
+    
+    // Keep at most n_jobs worker processes running
+    size_t next = 0, running = 0;
+    bool failed = false;
+    while (next < shards.size() || running > 0) {
+        if (next < shards.size() && running < n_jobs && !failed) {
+            std::vector<std::string> args = {
+                self_path, "--workers", std::to_string(n_workers), "--shard",
+                shards[next].data_file, std::to_string(shards[next].begin),
+                std::to_string(shards[next].end), part_files[next]
+            };
+            pid_t pid = fork();
+            if (pid == 0) {
+                std::vector<char*> argv;
+                for (std::string& arg : args) {
+                    argv.push_back(&arg[0]);
+                }
+                argv.push_back(nullptr);
+                // execvp also finds the program on PATH when only argv[0] is known
+                execvp(self_path.c_str(), argv.data());
+                _exit(127);
+            }
+            if (pid < 0) {
+                std::cerr << "Error: Could not start worker process" << std::endl;
+                failed = true;
+                continue;
+            }
+            next++;
+            running++;
+            continue;
+        }
+        if (running == 0) {
+            break;
+        }
+        
+        int status = 0;
+        if (wait(&status) > 0) {
+            running--;
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                failed = true;
+            }
+        }
+    }
+    
+    int result = 1;
+    if (failed) {
+        std::cerr << "Error: A worker process failed; results were not merged" << std::endl;
+    } else {
+        result = runMerge(part_files, results_file);
+    }
+    for (const std::string& part_file : part_files) {
+        std::remove(part_file.c_str());
+    }
+    return result;
+}
+
+#endif
+
+// Function to quote a command-line argument for a POSIX shell when needed
+std::string shellQuote(const std::string& arg) {
+    const char* safe = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_./:=+-";
+    if (!arg.empty() && arg.find_first_not_of(safe) == std::string::npos) {
+        return arg;
+    }
+    std::string quoted = "'";
+    for (char c : arg) {
+        quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    }
+    return quoted + "'";
+}
+
+// Print usage information
+void printUsage(const char* program) {
+    std::cerr << "Usage:\n"
+              << "  " << program << " [--jobs N] [--workers K] [data_file...]\n"
+              << "      Evaluate data files (default ../data/experimental_data.txt); with --jobs,\n"
+              << "      split them into shards evaluated by N local worker processes.\n"
+              << "  " << program << " --plan N data_file...\n"
+              << "      Print the --shard commands splitting the data files into N shards.\n"
+              << "  " << program << " [--workers K] --shard data_file begin end part_file\n"
+              << "      Evaluate records starting in bytes [begin, end) into a partial results file.\n"
+              << "  " << program << " --merge part_file...\n"
+              << "      Merge partial results files, in order, into the final report.\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string results_file = "wdel_formula2_evaluation_results_cpp.txt";
+    std::vector<std::string> args(argv + 1, argv + argc);
+    
+    size_t n_threads = std::thread::hardware_concurrency();
+    size_t n_workers = n_threads > 3 ? n_threads - 2 : 1;
+    size_t n_jobs = 1;
+    
+    std::vector<std::string> operands;
+    std::string mode;
+    for (size_t i = 0; i < args.size(); i++) {
+        if ((args[i] == "--jobs" || args[i] == "--workers" || args[i] == "--plan") && i + 1 < args.size()) {
+            uint64_t value = 0;
+            if (!parseUnsigned(args[i + 1], value) || value == 0) {
+                std::cerr << "Error: " << args[i] << " expects a positive integer, got: " << args[i + 1] << std::endl;
+                return 1;
+            }
+            if (args[i] == "--workers") {
+                n_workers = value;
+            } else {
+                n_jobs = value;
+                if (args[i] == "--plan") {
+                    mode = "plan";
+                }
+            }
+            i++;
+        } else if (args[i] == "--shard" || args[i] == "--merge") {
+            mode = args[i].substr(2);
+        } else if (args[i] == "--help" || args[i][0] == '-') {
+            printUsage(argv[0]);
+            return args[i] == "--help" ? 0 : 1;
+        } else {
+            operands.push_back(args[i]);
+        }
+    }
+    
+    if (mode == "shard") {
+        if (operands.size() != 4) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        ShardSpec shard = { operands[0], 0, 0 };
+        if (!parseUnsigned(operands[1], shard.begin) || !parseUnsigned(operands[2], shard.end)) {
+            std::cerr << "Error: --shard expects numeric byte offsets" << std::endl;
+            return 1;
+        }
+        return runShard(shard, operands[3], n_workers);
+    }
+    if (mode == "merge") {
+        if (operands.empty()) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return runMerge(operands, results_file);
+    }
+    
+    // Load test data from external file(s)
+    if (operands.empty()) {
+        operands.push_back("../data/experimental_data.txt");
+    }
+    
+    if (mode == "plan") {
+        std::vector<ShardSpec> shards = planShards(operands, n_jobs);
+        for (size_t i = 0; i < shards.size(); i++) {
+            std::cout << shellQuote(argv[0]) << " --shard " << shellQuote(shards[i].data_file)
+                      << " " << shards[i].begin << " " << shards[i].end << " "
+                      << shellQuote(partFileName(results_file, i)) << "\n";
+        }
+        return 0;
+    }
+    if (n_jobs > 1) {
+#ifdef WDEL_HAVE_PROCESSES
+        // Local worker processes share the machine's threads between them
+        return runCoordinator(selfPath(argv[0]), operands, results_file, n_jobs,
+                              std::max<size_t>(1, n_workers / n_jobs));
+#else
+        std::cerr << "Error: --jobs needs POSIX process support; use --plan, --shard and --merge" << std::endl;
+        return 1;
+#endif
+    }
+    return runSingleProcess(operands, results_file, n_workers);
+}